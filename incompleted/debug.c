@@ -8,8 +8,7 @@
 #include "debug.h"
 
 void pad(int n) {
-  int i;
-  for (i = 0; i < n ; i++) printf(" ");
+  printf("%*s", n, "");
 }
 
 void printType(Type* type) {
@@ -41,47 +40,63 @@ void printConstantValue(ConstantValue* value) {
   }
 }
 
+void printBlockHeader(Object* obj, int indent) {
+  switch (obj->kind) {
+  case OBJ_FUNCTION:
+    pad(indent);
+    printf("Function %s : ",obj->name);
+    printType(obj->funcAttrs.returnType);
+    printf("\n");
+    break;
+  case OBJ_PROCEDURE:
+    pad(indent);
+    printf("Procedure %s\n",obj->name);
+    break;
+  case OBJ_PROGRAM:
+    pad(indent);
+    printf("Program %s\n",obj->name);
+    break;
+  default:
+    break;
+  }
+}
+
 void printObject(Object* obj, int indent) {
   switch (obj->kind) {
   case OBJ_CONSTANT:
     pad(indent);
     printf("Const %s = ", obj->name);
-    printConstantValue(obj->constAttrs->value);
+    printConstantValue(obj->constAttrs.value);
     break;
   case OBJ_TYPE:
     pad(indent);
     printf("Type %s = ", obj->name);
-    printType(obj->typeAttrs->actualType);
+    printType(obj->typeAttrs.actualType);
     break;
   case OBJ_VARIABLE:
     pad(indent);
     printf("Var %s : ", obj->name);
-    printType(obj->varAttrs->type);
+    printType(obj->varAttrs.type);
     break;
   case OBJ_PARAMETER:
     pad(indent);
-    if (obj->paramAttrs->kind == PARAM_VALUE) 
+    if (obj->paramAttrs.kind == PARAM_VALUE) 
       printf("Param %s : ", obj->name);
     else
       printf("Param VAR %s : ", obj->name);
-    printType(obj->paramAttrs->type);
+    printType(obj->paramAttrs.type);
     break;
   case OBJ_FUNCTION:
-    pad(indent);
-    printf("Function %s : ",obj->name);
-    printType(obj->funcAttrs->returnType);
-    printf("\n");
-    printScope(obj->funcAttrs->scope, indent + 4);
+    printBlockHeader(obj, indent);
+    printScope(obj->funcAttrs.scope, indent + 4);
     break;
   case OBJ_PROCEDURE:
-    pad(indent);
-    printf("Procedure %s\n",obj->name);
-    printScope(obj->procAttrs->scope, indent + 4);
+    printBlockHeader(obj, indent);
+    printScope(obj->procAttrs.scope, indent + 4);
     break;
   case OBJ_PROGRAM:
-    pad(indent);
-    printf("Program %s\n",obj->name);
-    printScope(obj->progAttrs->scope, indent + 4);
+    printBlockHeader(obj, indent);
+    printScope(obj->progAttrs.scope, indent + 4);
     break;
   }
 }
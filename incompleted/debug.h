@@ -11,6 +11,7 @@
 
 void printType(Type* type);
 void printConstantValue(ConstantValue* value);
+void printBlockHeader(Object* obj, int indent);
 void printObject(Object* obj, int indent);
 void printObjectList(ObjectNode* objList, int indent);
 void printScope(Scope* scope, int indent);
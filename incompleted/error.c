@@ -6,16 +6,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "reader.h"
 #include "error.h"
 
-#define NUM_OF_ERRORS 29
+#define NUM_OF_ERRORS 31
 
 struct ErrorMessage {
   ErrorCode errorCode;
   char *message;
 };
 
-struct ErrorMessage errors[29] = {
+struct ErrorMessage errors[31] = {
   {ERR_END_OF_COMMENT, "End of comment expected."},
   {ERR_IDENT_TOO_LONG, "Identifier too long."},
   {ERR_INVALID_CONSTANT_CHAR, "Invalid char constant."},
@@ -23,6 +24,7 @@ struct ErrorMessage errors[29] = {
   {ERR_INVALID_IDENT, "An identifier expected."},
   {ERR_INVALID_CONSTANT, "A constant expected."},
   {ERR_INVALID_TYPE, "A type expected."},
+  {ERR_INVALID_ARRAY_SIZE, "Invalid array size."},
   {ERR_INVALID_BASICTYPE, "A basic type expected."},
   {ERR_INVALID_VARIABLE, "A variable expected."},
   {ERR_INVALID_FUNCTION, "A function identifier expected."},
@@ -44,11 +46,13 @@ struct ErrorMessage errors[29] = {
   {ERR_UNDECLARED_PROCEDURE, "Undeclared procedure."},
   {ERR_DUPLICATE_IDENT, "Duplicate identifier."},
   {ERR_TYPE_INCONSISTENCY, "Type inconsistency"},
-  {ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, "The number of arguments and the number of parameters are inconsistent."}
+  {ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY, "The number of arguments and the number of parameters are inconsistent."},
+  {ERR_FRAME_TOO_LARGE, "Too many local variables: frame too large."}
 };
 
-void error(ErrorCode err, int lineNo, int colNo) {
-  int i;
+void error(ErrorCode err, int offset) {
+  int i, lineNo, colNo;
+  getLineCol(offset, &lineNo, &colNo);
   for (i = 0 ; i < NUM_OF_ERRORS; i ++) 
     if (errors[i].errorCode == err) {
       printf("%d-%d:%s\n", lineNo, colNo, errors[i].message);
@@ -56,7 +60,9 @@ void error(ErrorCode err, int lineNo, int colNo) {
     }
 }
 
-void missingToken(TokenType tokenType, int lineNo, int colNo) {
+void missingToken(TokenType tokenType, int offset) {
+  int lineNo, colNo;
+  getLineCol(offset, &lineNo, &colNo);
   printf("%d-%d:Missing %s\n", lineNo, colNo, tokenToString(tokenType));
   exit(0);
 }
@@ -40,11 +40,12 @@ typedef enum {
     ERR_UNDECLARED_PROCEDURE,
     ERR_DUPLICATE_IDENT,
     ERR_TYPE_INCONSISTENCY,
-    ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY
+    ERR_PARAMETERS_ARGUMENTS_INCONSISTENCY,
+    ERR_FRAME_TOO_LARGE
 } ErrorCode;
 
-void error(ErrorCode err, int lineNo, int colNo);
-void missingToken(TokenType tokenType, int lineNo, int colNo);
+void error(ErrorCode err, int offset);
+void missingToken(TokenType tokenType, int offset);
 void assert(char *msg);
 
 #endif
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "reader.h"
 #include "parser.h"
@@ -13,12 +14,21 @@
 /******************************************************************/
 
 int main(int argc, char *argv[]) {
+  char *fileName = argv[1];
+
+  // -s: in và giải phóng từng thủ tục ngay khi phân tích xong
+  if (argc > 1 && strcmp(argv[1], "-s") == 0) {
+    streamingMode = 1;
+    fileName = argv[2];
+    argc --;
+  }
+
   if (argc <= 1) {
     printf("parser: no input file.\n");
     return -1;
   }
 
-  if (compile(argv[1]) == IO_ERROR) {
+  if (compile(fileName) == IO_ERROR) {
     printf("Can\'t read input file!\n");
     return -1;
   }
@@ -20,6 +20,29 @@ extern Type* intType;
 extern Type* charType;
 extern SymTab* symtab;
 
+// Chế độ streaming: in từng khai báo ngay khi hoàn tất và giải phóng scope
+// cục bộ khi ra khỏi khối, thay vì giữ cả bảng ký hiệu đến cuối
+int streamingMode = 0;
+
+void emitObject(Object* obj) {
+	if (streamingMode) {
+		printObject(obj, 4 * (symtab->currentScope->level + 1));
+		printf("\n");
+	}
+}
+
+void emitBlockHeader(Object* owner, ObjectNode* paramList) {
+	if (streamingMode) {
+		printBlockHeader(owner, 4 * symtab->currentScope->level);
+		printObjectList(paramList, 4 * (symtab->currentScope->level + 1));
+	}
+}
+
+void emitBlockEnd(void) {
+	if (streamingMode)
+		printf("\n");
+}
+
 void scan(void) {
 	Token* tmp = currentToken;
 	currentToken = lookAhead;
@@ -30,7 +53,7 @@ void scan(void) {
 void eat(TokenType tokenType) {
 	if (lookAhead->tokenType == tokenType) {
 		scan();
-	} else missingToken(tokenType, lookAhead->lineNo, lookAhead->colNo);
+	} else missingToken(tokenType, lookAhead->offset);
 }
 
 void compileProgram(void) {
@@ -48,7 +71,8 @@ void compileProgram(void) {
 	eat(TK_IDENT);
 
 	// 2. Vào scope của program
-	enterBlock(program->progAttrs->scope);
+	enterBlock(program->progAttrs.scope);
+	emitBlockHeader(program, NULL);
 
 	eat(SB_SEMICOLON);
 	compileBlock();
@@ -82,7 +106,8 @@ void compileBlock(void) {
 			eat(SB_EQ);
 			// 3. Phân tích hằng số và gán giá trị
 			constVal = compileConstant();
-			constObj->constAttrs->value = constVal;
+			constObj->constAttrs.value = constVal;
+			emitObject(constObj);
 
 			eat(SB_SEMICOLON);
 		} while (lookAhead->tokenType == TK_IDENT);
@@ -115,7 +140,8 @@ void compileBlock2(void) {
 			eat(SB_EQ);
 			// 3. Phân tích kiểu dữ liệu và gán actualType
 			actualType = compileType();
-			typeObj->typeAttrs->actualType = actualType;
+			typeObj->typeAttrs.actualType = actualType;
+			emitObject(typeObj);
 
 			eat(SB_SEMICOLON);
 		} while (lookAhead->tokenType == TK_IDENT);
@@ -133,6 +159,7 @@ void compileBlock3(void) {
 		do {
 			Object* varObj = NULL;
 			Type* varType = NULL;
+			int varOffset = lookAhead->offset;
 
 			// Lấy tên biến
 			if (lookAhead->tokenType == TK_IDENT) {
@@ -141,14 +168,17 @@ void compileBlock3(void) {
 				varObj = createVariableObject("");
 			}
 			eat(TK_IDENT);
-			
-			// 2. Khai báo (add) vào scope hiện tại
-			declareObject(varObj);
 
 			eat(SB_COLON);
-			// 3. Phân tích kiểu dữ liệu và gán type
+			// 2. Phân tích kiểu dữ liệu và gán type
 			varType = compileType();
-			varObj->varAttrs->type = varType;
+			varObj->varAttrs.type = varType;
+
+			// 3. Khai báo (add) vào scope hiện tại, sau khi đã biết kích thước
+			declareObject(varObj);
+			if (varObj->varAttrs.localOffset < 0)
+				error(ERR_FRAME_TOO_LARGE, varOffset);
+			emitObject(varObj);
 
 			eat(SB_SEMICOLON);
 		} while (lookAhead->tokenType == TK_IDENT);
@@ -193,7 +223,7 @@ void compileFuncDecl(void) {
 	// 2. Khai báo (add) vào scope cha
 	declareObject(funcObj);
 	// 3. Vào scope của hàm (function scope)
-	enterBlock(funcObj->funcAttrs->scope); 
+	enterBlock(funcObj->funcAttrs.scope); 
 
 	eat(TK_IDENT);
 	compileParams();
@@ -201,11 +231,17 @@ void compileFuncDecl(void) {
 	
 	// 4. Phân tích kiểu trả về
 	returnType = compileBasicType();
-	funcObj->funcAttrs->returnType = returnType;
+	funcObj->funcAttrs.returnType = returnType;
+	emitBlockHeader(funcObj, funcObj->funcAttrs.paramList);
 
 	eat(SB_SEMICOLON);
 	compileBlock();
 	eat(SB_SEMICOLON);
+	emitBlockEnd();
+
+	// Ở chế độ streaming, các khai báo cục bộ đã được in ra nên giải phóng ngay
+	if (streamingMode)
+		releaseScope(funcObj->funcAttrs.scope);
 
 	// 5. Thoát scope của hàm
 	exitBlock();
@@ -225,18 +261,36 @@ void compileProcDecl(void) {
 	// 2. Khai báo (add) vào scope cha
 	declareObject(procObj);
 	// 3. Vào scope của thủ tục (procedure scope)
-	enterBlock(procObj->procAttrs->scope); 
+	enterBlock(procObj->procAttrs.scope); 
 	
 	eat(TK_IDENT);
 	compileParams();
+	emitBlockHeader(procObj, procObj->procAttrs.paramList);
 	eat(SB_SEMICOLON);
 	compileBlock();
 	eat(SB_SEMICOLON);
+	emitBlockEnd();
+
+	// Ở chế độ streaming, các khai báo cục bộ đã được in ra nên giải phóng ngay
+	if (streamingMode)
+		releaseScope(procObj->procAttrs.scope);
 
 	// 4. Thoát scope của thủ tục
 	exitBlock();
 }
 
+// Giá trị của một hằng đã khai báo được tính ngay khi dịch và gấp vào
+// khai báo đang xét, thay vì để lại giá trị tạm
+ConstantValue* compileConstantIdent(Token* token) {
+	Object* obj = lookupObject(token->string);
+
+	if (obj == NULL || obj->kind != OBJ_CONSTANT || obj->constAttrs.value == NULL) {
+		error(ERR_UNDECLARED_CONSTANT, token->offset);
+		return NULL;
+	}
+	return duplicateConstantValue(obj->constAttrs.value);
+}
+
 ConstantValue* compileUnsignedConstant(void) {
 	// TODO: create and return an unsigned constant value
 	ConstantValue* constValue = NULL;
@@ -248,12 +302,9 @@ ConstantValue* compileUnsignedConstant(void) {
 		eat(TK_NUMBER);
 		break;
 	case TK_IDENT:
-		// TK_IDENT (Hằng số đã khai báo) - sẽ xử lý semantic sau
-		// Tạo giá trị hằng số tạm thời
-		constValue = (ConstantValue*)malloc(sizeof(ConstantValue)); 
-		constValue->type = TP_INT; 
-		constValue->intValue = 0;
+		// TK_IDENT (Hằng số đã khai báo): lấy giá trị ngay lúc dịch
 		eat(TK_IDENT);
+		constValue = compileConstantIdent(currentToken);
 		break;
 	case TK_CHAR:
 		// Lưu giá trị ký tự
@@ -261,7 +312,7 @@ ConstantValue* compileUnsignedConstant(void) {
 		eat(TK_CHAR);
 		break;
 	default:
-		error(ERR_INVALID_CONSTANT, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_CONSTANT, lookAhead->offset);
 		break;
 	}
 	return constValue;
@@ -276,7 +327,7 @@ ConstantValue* compileConstant(void) {
 		eat(SB_PLUS);
 		constValue = compileConstant2();
 		if (constValue != NULL && constValue->type != TP_INT) {
-			error(ERR_INVALID_CONSTANT, currentToken->lineNo, currentToken->colNo);
+			error(ERR_INVALID_CONSTANT, currentToken->offset);
 			free(constValue);
 			constValue = NULL;
 		}
@@ -285,7 +336,7 @@ ConstantValue* compileConstant(void) {
 		eat(SB_MINUS);
 		constValue = compileConstant2();
 		if (constValue != NULL && constValue->type != TP_INT) {
-			error(ERR_INVALID_CONSTANT, currentToken->lineNo, currentToken->colNo);
+			error(ERR_INVALID_CONSTANT, currentToken->offset);
 			free(constValue);
 			constValue = NULL;
 		} else if (constValue != NULL) {
@@ -315,15 +366,12 @@ ConstantValue* compileConstant2(void) {
 		eat(TK_NUMBER);
 		break;
 	case TK_IDENT:
-		// TK_IDENT (Hằng số đã khai báo) - sẽ xử lý semantic sau
-		// Tạo giá trị hằng số tạm thời
-		constValue = (ConstantValue*)malloc(sizeof(ConstantValue)); 
-		constValue->type = TP_INT; 
-		constValue->intValue = 0;
+		// TK_IDENT (Hằng số đã khai báo): lấy giá trị ngay lúc dịch
 		eat(TK_IDENT);
+		constValue = compileConstantIdent(currentToken);
 		break;
 	default:
-		error(ERR_INVALID_CONSTANT, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_CONSTANT, lookAhead->offset);
 		break;
 	}
 	return constValue;
@@ -350,22 +398,34 @@ Type* compileType(void) {
 		if (lookAhead->tokenType == TK_NUMBER || lookAhead->tokenType == TK_IDENT) {
 			
 			int arraySize = 0;
+			int sizeOffset = lookAhead->offset;
 			if (lookAhead->tokenType == TK_NUMBER) {
 				arraySize = lookAhead->value;
 				eat(TK_NUMBER);
-			} else { // TK_IDENT (sẽ kiểm tra semantic sau)
+			} else { // TK_IDENT: phải là hằng số nguyên đã khai báo
+				ConstantValue* sizeValue;
 				eat(TK_IDENT);
+				sizeValue = compileConstantIdent(currentToken);
+				if (sizeValue->type != TP_INT)
+					error(ERR_UNDECLARED_INT_CONSTANT, currentToken->offset);
+				arraySize = sizeValue->intValue;
+				free(sizeValue);
 			}
+			// Kích thước mảng phải dương, dù là số hay hằng số đã khai báo
+			if (arraySize <= 0)
+				error(ERR_INVALID_ARRAY_SIZE, sizeOffset);
 			
 			eat(SB_RSEL);
 			eat(KW_OF);
 			
 			Type* elementType = compileType();
 			type = makeArrayType(arraySize, elementType);
+			if (type == NULL)
+				error(ERR_INVALID_ARRAY_SIZE, sizeOffset);
 
 		} else {
 			// Lỗi: Kích thước mảng không phải là số hoặc định danh hằng số
-			error(ERR_INVALID_ARRAY_SIZE, lookAhead->lineNo, lookAhead->colNo);
+			error(ERR_INVALID_ARRAY_SIZE, lookAhead->offset);
 			
 			// Cơ chế phục hồi lỗi đơn giản: Skip token
 			if (lookAhead->tokenType == SB_RSEL) 
@@ -381,11 +441,10 @@ Type* compileType(void) {
 	case TK_IDENT:
 		// TK_IDENT (Kiểu dữ liệu đã khai báo) - sẽ xử lý semantic sau
 		eat(TK_IDENT);
-		type = (Type*)malloc(sizeof(Type)); // Kiểu tạm
-		type->typeClass = TP_INT; // Giả định kiểu int tạm thời
+		type = makeIntType(); // Kiểu tạm, giả định kiểu int tạm thời
 		break;
 	default:
-		error(ERR_INVALID_TYPE, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_TYPE, lookAhead->offset);
 		break;
 	}
 	return type;
@@ -405,7 +464,7 @@ Type* compileBasicType(void) {
 		type = charType; // Trả về charType global (chia sẻ)
 		break;
 	default:
-		error(ERR_INVALID_BASICTYPE, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_BASICTYPE, lookAhead->offset);
 		break;
 	}
 	return type;
@@ -447,7 +506,7 @@ void compileParam(void) {
 		paramType = compileBasicType();
 		
 		// 2. Gán type
-		paramObj->paramAttrs->type = paramType;
+		paramObj->paramAttrs.type = paramType;
 		// 3. Khai báo (add) vào scope hiện tại và paramList của owner
 		declareObject(paramObj);
 		break;
@@ -466,12 +525,12 @@ void compileParam(void) {
 		paramType = compileBasicType();
 
 		// 2. Gán type
-		paramObj->paramAttrs->type = paramType;
+		paramObj->paramAttrs.type = paramType;
 		// 3. Khai báo (add) vào scope hiện tại và paramList của owner
 		declareObject(paramObj);
 		break;
 	default:
-		error(ERR_INVALID_PARAMETER, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_PARAMETER, lookAhead->offset);
 		break;
 	}
 }
@@ -490,38 +549,119 @@ void compileStatements(void) {
 	}
 }
 
-void compileStatement(void) {
+/* Các câu lệnh lồng nhau (BEGIN, IF, WHILE, FOR) được phân tích bằng một
+ * ngăn xếp cấp phát trên heap thay vì đệ quy, để độ sâu lồng nhau chỉ bị
+ * giới hạn bởi bộ nhớ chứ không bởi kích thước stack của luồng. */
+typedef enum {
+	PS_GROUP,		// đang ở trong BEGIN ... END
+	PS_IF			// đã xong nhánh THEN, có thể còn ELSE
+} ParseState;
+
+typedef struct {
+	ParseState* states;
+	int top;
+	int capacity;
+} ParseStack;
+
+void pushParseState(ParseStack* stack, ParseState state) {
+	if (stack->top == stack->capacity) {
+		stack->capacity = (stack->capacity == 0) ? 16 : stack->capacity * 2;
+		stack->states = (ParseState*) realloc(stack->states, stack->capacity * sizeof(ParseState));
+		if (stack->states == NULL) {
+			printf("Out of memory.\n");
+			exit(-1);
+		}
+	}
+	stack->states[stack->top++] = state;
+}
+
+// Phân tích phần đầu của một câu lệnh. Trả về 1 nếu còn một câu lệnh con
+// cần phân tích tiếp (thân của BEGIN/IF/WHILE/FOR), 0 nếu câu lệnh đã kết thúc.
+int compileStatementHead(ParseStack* stack) {
 	switch (lookAhead->tokenType) {
 	case TK_IDENT:
 		compileAssignSt();
-		break;
+		return 0;
 	case KW_CALL:
 		compileCallSt();
-		break;
+		return 0;
 	case KW_BEGIN:
-		compileGroupSt();
-		break;
+		eat(KW_BEGIN);
+		if (lookAhead->tokenType == SB_SEMICOLON || lookAhead->tokenType == KW_END || lookAhead->tokenType == KW_ELSE) {
+			eat(KW_END);
+			return 0;
+		}
+		pushParseState(stack, PS_GROUP);
+		return 1;
 	case KW_IF:
-		compileIfSt();
-		break;
+		eat(KW_IF);
+		compileCondition();
+		eat(KW_THEN);
+		pushParseState(stack, PS_IF);
+		return 1;
 	case KW_WHILE:
-		compileWhileSt();
-		break;
+		eat(KW_WHILE);
+		compileCondition();
+		eat(KW_DO);
+		return 1;
 	case KW_FOR:
-		compileForSt();
-		break;
+		eat(KW_FOR);
+		eat(TK_IDENT);
+		eat(SB_ASSIGN);
+		compileExpression();
+		eat(KW_TO);
+		compileExpression();
+		eat(KW_DO);
+		return 1;
 		// EmptySt
 	case SB_SEMICOLON:
 	case KW_END:
 	case KW_ELSE:
-		break;
+		return 0;
 		// Error occurs
 	default:
-		error(ERR_INVALID_STATEMENT, lookAhead->lineNo, lookAhead->colNo);
-		break;
+		error(ERR_INVALID_STATEMENT, lookAhead->offset);
+		return 0;
 	}
 }
 
+void compileStatement(void) {
+	ParseStack stack;
+	int nested;
+
+	stack.states = NULL;
+	stack.top = 0;
+	stack.capacity = 0;
+
+	do {
+		nested = compileStatementHead(&stack);
+
+		// Câu lệnh hiện tại đã xong: tiếp tục các cấu trúc bao ngoài
+		while (!nested && stack.top > 0) {
+			switch (stack.states[stack.top - 1]) {
+			case PS_GROUP:
+				if (lookAhead->tokenType == SB_SEMICOLON) {
+					eat(SB_SEMICOLON);
+					nested = 1;
+				} else {
+					eat(KW_END);
+					stack.top--;
+				}
+				break;
+			case PS_IF:
+				stack.top--;
+				if (lookAhead->tokenType == KW_ELSE) {
+					eat(KW_ELSE);
+					nested = 1;
+				}
+				break;
+			}
+		}
+	} while (nested);
+
+	free(stack.states);
+}
+
 void compileLValue(void) {
 	eat(TK_IDENT);
 	compileIndexes();
@@ -539,44 +679,6 @@ void compileCallSt(void) {
 	compileArguments();
 }
 
-void compileGroupSt(void) {
-	eat(KW_BEGIN);
-	compileStatements();
-	eat(KW_END);
-}
-
-void compileIfSt(void) {
-	eat(KW_IF);
-	compileCondition();
-	eat(KW_THEN);
-	compileStatement();
-	if (lookAhead->tokenType == KW_ELSE) 
-		compileElseSt();
-}
-
-void compileElseSt(void) {
-	eat(KW_ELSE);
-	compileStatement();
-}
-
-void compileWhileSt(void) {
-	eat(KW_WHILE);
-	compileCondition();
-	eat(KW_DO);
-	compileStatement();
-}
-
-void compileForSt(void) {
-	eat(KW_FOR);
-	eat(TK_IDENT);
-	eat(SB_ASSIGN);
-	compileExpression();
-	eat(KW_TO);
-	compileExpression();
-	eat(KW_DO);
-	compileStatement();
-}
-
 void compileArgument(void) {
 	compileExpression();
 }
@@ -616,7 +718,7 @@ void compileArguments(void) {
 	case KW_THEN:
 		break;
 	default:
-		error(ERR_INVALID_ARGUMENTS, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_ARGUMENTS, lookAhead->offset);
 	}
 }
 
@@ -642,7 +744,7 @@ void compileCondition(void) {
 		eat(SB_GT);
 		break;
 	default:
-		error(ERR_INVALID_COMPARATOR, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_COMPARATOR, lookAhead->offset);
 	}
 
 	compileExpression();
@@ -670,17 +772,12 @@ void compileExpression2(void) {
 
 
 void compileExpression3(void) {
-	switch (lookAhead->tokenType) {
-	case SB_PLUS:
-		eat(SB_PLUS);
-		compileTerm();
-		compileExpression3();
-		break;
-	case SB_MINUS:
-		eat(SB_MINUS);
+	while (lookAhead->tokenType == SB_PLUS || lookAhead->tokenType == SB_MINUS) {
+		eat(lookAhead->tokenType);
 		compileTerm();
-		compileExpression3();
-		break;
+	}
+
+	switch (lookAhead->tokenType) {
 		// check the FOLLOW set
 	case KW_TO:
 	case KW_DO:
@@ -699,7 +796,7 @@ void compileExpression3(void) {
 	case KW_THEN:
 		break;
 	default:
-		error(ERR_INVALID_EXPRESSION, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_EXPRESSION, lookAhead->offset);
 	}
 }
 
@@ -709,17 +806,12 @@ void compileTerm(void) {
 }
 
 void compileTerm2(void) {
-	switch (lookAhead->tokenType) {
-	case SB_TIMES:
-		eat(SB_TIMES);
-		compileFactor();
-		compileTerm2();
-		break;
-	case SB_SLASH:
-		eat(SB_SLASH);
+	while (lookAhead->tokenType == SB_TIMES || lookAhead->tokenType == SB_SLASH) {
+		eat(lookAhead->tokenType);
 		compileFactor();
-		compileTerm2();
-		break;
+	}
+
+	switch (lookAhead->tokenType) {
 		// check the FOLLOW set
 	case SB_PLUS:
 	case SB_MINUS:
@@ -740,7 +832,7 @@ void compileTerm2(void) {
 	case KW_THEN:
 		break;
 	default:
-		error(ERR_INVALID_TERM, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_TERM, lookAhead->offset);
 	}
 }
 
@@ -766,7 +858,7 @@ void compileFactor(void) {
 		}
 		break;
 	default:
-		error(ERR_INVALID_FACTOR, lookAhead->lineNo, lookAhead->colNo);
+		error(ERR_INVALID_FACTOR, lookAhead->offset);
 	}
 }
 
@@ -789,7 +881,8 @@ int compile(char *fileName) {
 
 	compileProgram();
 
-	printObject(symtab->program,0);
+	if (!streamingMode)
+		printObject(symtab->program,0);
 
 	cleanSymTab();
 
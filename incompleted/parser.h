@@ -8,6 +8,8 @@
 #include "token.h"
 #include "symtab.h"
 
+extern int streamingMode;
+
 void scan(void);
 void eat(TokenType tokenType);
 
@@ -26,6 +28,7 @@ void compileVarDecl(void);
 void compileSubDecls(void);
 void compileFuncDecl(void);
 void compileProcDecl(void);
+ConstantValue* compileConstantIdent(Token* token);
 ConstantValue* compileUnsignedConstant(void);
 ConstantValue* compileConstant(void);
 ConstantValue* compileConstant2(void);
@@ -38,11 +41,6 @@ void compileStatement(void);
 void compileLValue(void);
 void compileAssignSt(void);
 void compileCallSt(void);
-void compileGroupSt(void);
-void compileIfSt(void);
-void compileElseSt(void);
-void compileWhileSt(void);
-void compileForSt(void);
 void compileArgument(void);
 void compileArguments(void);
 void compileCondition(void);
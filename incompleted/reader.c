@@ -5,33 +5,113 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "reader.h"
 
-FILE *inputStream;
-int lineNo, colNo;
+#define READ_CHUNK_SIZE 65536
+
+// Toàn bộ mã nguồn được nạp vào bộ nhớ một lần; readChar chỉ tăng chỉ số
+char *inputBuffer;
+size_t inputSize;
+int currentOffset;
 int currentChar;
 
+// Bảng vị trí đầu dòng, chỉ được dựng khi cần in vị trí dòng-cột
+int *lineStarts;
+int lineCount;
+
 int readChar(void) {
-  currentChar = getc(inputStream);
-  colNo ++;
-  if (currentChar == '\n') {
-    lineNo ++;
-    colNo = 0;
-  }
+  currentOffset ++;
+  if ((size_t) currentOffset < inputSize)
+    currentChar = (unsigned char) inputBuffer[currentOffset];
+  else currentChar = EOF;
   return currentChar;
 }
 
+void buildLineTable(void) {
+  char *p = inputBuffer;
+  char *end = inputBuffer + inputSize;
+  int capacity = 1;
+
+  while ((p = memchr(p, '\n', end - p)) != NULL) {
+    capacity ++;
+    p ++;
+  }
+
+  lineStarts = (int*) malloc(capacity * sizeof(int));
+  lineStarts[0] = 0;
+  lineCount = 1;
+  p = inputBuffer;
+  while ((p = memchr(p, '\n', end - p)) != NULL) {
+    p ++;
+    lineStarts[lineCount++] = p - inputBuffer;
+  }
+}
+
+void getLineCol(int offset, int *lineNo, int *colNo) {
+  int lo = 0, hi, mid;
+
+  if (lineStarts == NULL) buildLineTable();
+
+  // Tìm dòng cuối cùng bắt đầu không sau offset
+  hi = lineCount - 1;
+  while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if (lineStarts[mid] <= offset) lo = mid;
+    else hi = mid - 1;
+  }
+  *lineNo = lo + 1;
+  *colNo = offset - lineStarts[lo] + 1;
+}
+
 int openInputStream(char *fileName) {
+  FILE *inputStream;
+  size_t capacity = READ_CHUNK_SIZE;
+  size_t n;
+  char *grown;
+  int failed = 0;
+
   inputStream = fopen(fileName, "rt");
   if (inputStream == NULL)
     return IO_ERROR;
-  lineNo = 1;
-  colNo = 0;
+
+  inputBuffer = (char*) malloc(capacity);
+  inputSize = 0;
+  if (inputBuffer == NULL) failed = 1;
+  while (!failed &&
+         (n = fread(inputBuffer + inputSize, 1, capacity - inputSize, inputStream)) > 0) {
+    inputSize += n;
+    // Vị trí token là int nên không nhận tệp lớn hơn INT_MAX byte
+    if (inputSize > INT_MAX) failed = 1;
+    else if (inputSize == capacity) {
+      capacity *= 2;
+      grown = (char*) realloc(inputBuffer, capacity);
+      if (grown == NULL) failed = 1;
+      else inputBuffer = grown;
+    }
+  }
+  if (ferror(inputStream)) failed = 1;
+  fclose(inputStream);
+  if (failed) {
+    free(inputBuffer);
+    inputBuffer = NULL;
+    inputSize = 0;
+    return IO_ERROR;
+  }
+
+  lineStarts = NULL;
+  lineCount = 0;
+  currentOffset = -1;
   readChar();
   return IO_SUCCESS;
 }
 
 void closeInputStream() {
-  fclose(inputStream);
+  free(inputBuffer);
+  free(lineStarts);
+  inputBuffer = NULL;
+  lineStarts = NULL;
 }
 
@@ -11,6 +11,7 @@
 #define IO_SUCCESS 1
 
 int readChar(void);
+void getLineCol(int offset, int *lineNo, int *colNo);
 int openInputStream(char *fileName);
 void closeInputStream(void);
 
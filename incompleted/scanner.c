@@ -15,8 +15,7 @@
 #include "scanner.h"
 
 
-extern int lineNo;
-extern int colNo;
+extern int currentOffset;
 extern int currentChar;
 
 extern CharCode charCodes[];
@@ -45,11 +44,11 @@ void skipComment() {
     readChar();
   }
   if (state != 2) 
-    error(ERR_END_OF_COMMENT, lineNo, colNo);
+    error(ERR_END_OF_COMMENT, currentOffset);
 }
 
 Token* readIdentKeyword(void) {
-  Token *token = makeToken(TK_NONE, lineNo, colNo);
+  Token *token = makeToken(TK_NONE, currentOffset);
   int count = 1;
 
   token->string[0] = toupper((char)currentChar);
@@ -62,7 +61,7 @@ Token* readIdentKeyword(void) {
   }
 
   if (count > MAX_IDENT_LEN) {
-    error(ERR_IDENT_TOO_LONG, token->lineNo, token->colNo);
+    error(ERR_IDENT_TOO_LONG, token->offset);
     return token;
   }
 
@@ -76,7 +75,7 @@ Token* readIdentKeyword(void) {
 }
 
 Token* readNumber(void) {
-  Token *token = makeToken(TK_NUMBER, lineNo, colNo);
+  Token *token = makeToken(TK_NUMBER, currentOffset);
   int count = 0;
 
   while ((currentChar != EOF) && (charCodes[currentChar] == CHAR_DIGIT)) {
@@ -90,12 +89,12 @@ Token* readNumber(void) {
 }
 
 Token* readConstChar(void) {
-  Token *token = makeToken(TK_CHAR, lineNo, colNo);
+  Token *token = makeToken(TK_CHAR, currentOffset);
 
   readChar();
   if (currentChar == EOF) {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    error(ERR_INVALID_CONSTANT_CHAR, token->offset);
     return token;
   }
     
@@ -105,7 +104,7 @@ Token* readConstChar(void) {
   readChar();
   if (currentChar == EOF) {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    error(ERR_INVALID_CONSTANT_CHAR, token->offset);
     return token;
   }
 
@@ -114,122 +113,85 @@ Token* readConstChar(void) {
     return token;
   } else {
     token->tokenType = TK_NONE;
-    error(ERR_INVALID_CONSTANT_CHAR, token->lineNo, token->colNo);
+    error(ERR_INVALID_CONSTANT_CHAR, token->offset);
     return token;
   }
 }
 
+/* Luật cho các ký hiệu một hoặc hai ký tự, đánh chỉ số theo lớp ký tự.
+ * single là token khi ký tự đứng một mình (TK_NONE nếu không hợp lệ),
+ * pair là token ghép khi ký tự tiếp theo thuộc lớp next (TK_NONE nếu không có).
+ * Bảng này chỉ gom các trường hợp đặc biệt vào dữ liệu, hành vi và tốc độ
+ * giống hệt bản switch trước đó. Mở chú thích "(*" vẫn được xử lý riêng
+ * trong getToken vì nó không sinh ra token. */
+struct SymbolRule {
+  TokenType single;
+  CharCode next;
+  TokenType pair;
+};
+
+struct SymbolRule symbolRules[CHAR_UNKNOWN + 1] = {
+  [CHAR_PLUS]         = {SB_PLUS,      CHAR_UNKNOWN, TK_NONE},
+  [CHAR_MINUS]        = {SB_MINUS,     CHAR_UNKNOWN, TK_NONE},
+  [CHAR_TIMES]        = {SB_TIMES,     CHAR_UNKNOWN, TK_NONE},
+  [CHAR_SLASH]        = {SB_SLASH,     CHAR_UNKNOWN, TK_NONE},
+  [CHAR_LT]           = {SB_LT,        CHAR_EQ,      SB_LE},
+  [CHAR_GT]           = {SB_GT,        CHAR_EQ,      SB_GE},
+  [CHAR_EXCLAIMATION] = {TK_NONE,      CHAR_EQ,      SB_NEQ},
+  [CHAR_EQ]           = {SB_EQ,        CHAR_UNKNOWN, TK_NONE},
+  [CHAR_COMMA]        = {SB_COMMA,     CHAR_UNKNOWN, TK_NONE},
+  [CHAR_PERIOD]       = {SB_PERIOD,    CHAR_RPAR,    SB_RSEL},
+  [CHAR_COLON]        = {SB_COLON,     CHAR_EQ,      SB_ASSIGN},
+  [CHAR_SEMICOLON]    = {SB_SEMICOLON, CHAR_UNKNOWN, TK_NONE},
+  [CHAR_LPAR]         = {SB_LPAR,      CHAR_PERIOD,  SB_LSEL},
+  [CHAR_RPAR]         = {SB_RPAR,      CHAR_UNKNOWN, TK_NONE}
+};
+
 Token* getToken(void) {
   Token *token;
-  int ln, cn;
-
-  if (currentChar == EOF) 
-    return makeToken(TK_EOF, lineNo, colNo);
-
-  switch (charCodes[currentChar]) {
-  case CHAR_SPACE: skipBlank(); return getToken();
-  case CHAR_LETTER: return readIdentKeyword();
-  case CHAR_DIGIT: return readNumber();
-  case CHAR_PLUS: 
-    token = makeToken(SB_PLUS, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_MINUS:
-    token = makeToken(SB_MINUS, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_TIMES:
-    token = makeToken(SB_TIMES, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_SLASH:
-    token = makeToken(SB_SLASH, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_LT:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
-      readChar();
-      return makeToken(SB_LE, ln, cn);
-    } else return makeToken(SB_LT, ln, cn);
-  case CHAR_GT:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
-      readChar();
-      return makeToken(SB_GE, ln, cn);
-    } else return makeToken(SB_GT, ln, cn);
-  case CHAR_EQ: 
-    token = makeToken(SB_EQ, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_EXCLAIMATION:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
-      readChar();
-      return makeToken(SB_NEQ, ln, cn);
-    } else {
-      token = makeToken(TK_NONE, ln, cn);
-      error(ERR_INVALID_SYMBOL, ln, cn);
+  struct SymbolRule *rule;
+  CharCode code;
+  int offset;
+
+  // Khoảng trắng và chú thích được bỏ qua trong vòng lặp thay vì gọi đệ quy
+  for (;;) {
+    if (currentChar == EOF) 
+      return makeToken(TK_EOF, currentOffset);
+
+    code = charCodes[currentChar];
+    switch (code) {
+    case CHAR_SPACE: skipBlank(); continue;
+    case CHAR_LETTER: return readIdentKeyword();
+    case CHAR_DIGIT: return readNumber();
+    case CHAR_SINGLEQUOTE: return readConstChar();
+    case CHAR_UNKNOWN:
+      token = makeToken(TK_NONE, currentOffset);
+      error(ERR_INVALID_SYMBOL, currentOffset);
+      readChar(); 
       return token;
+    default:
+      break;
     }
-  case CHAR_COMMA:
-    token = makeToken(SB_COMMA, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_PERIOD:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_RPAR)) {
-      readChar();
-      return makeToken(SB_RSEL, ln, cn);
-    } else return makeToken(SB_PERIOD, ln, cn);
-  case CHAR_SEMICOLON:
-    token = makeToken(SB_SEMICOLON, lineNo, colNo);
-    readChar(); 
-    return token;
-  case CHAR_COLON:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
-    if ((currentChar != EOF) && (charCodes[currentChar] == CHAR_EQ)) {
-      readChar();
-      return makeToken(SB_ASSIGN, ln, cn);
-    } else return makeToken(SB_COLON, ln, cn);
-  case CHAR_SINGLEQUOTE: return readConstChar();
-  case CHAR_LPAR:
-    ln = lineNo;
-    cn = colNo;
-    readChar();
 
-    if (currentChar == EOF) 
-      return makeToken(SB_LPAR, ln, cn);
+    rule = &symbolRules[code];
+    offset = currentOffset;
+    readChar();
 
-    switch (charCodes[currentChar]) {
-    case CHAR_PERIOD:
-      readChar();
-      return makeToken(SB_LSEL, ln, cn);
-    case CHAR_TIMES:
-      readChar();
-      skipComment();
-      return getToken();
-    default:
-      return makeToken(SB_LPAR, ln, cn);
+    if (currentChar != EOF) {
+      if ((code == CHAR_LPAR) && (charCodes[currentChar] == CHAR_TIMES)) {
+        readChar();
+        skipComment();
+        continue;
+      }
+      if ((rule->pair != TK_NONE) && (charCodes[currentChar] == rule->next)) {
+        readChar();
+        return makeToken(rule->pair, offset);
+      }
     }
-  case CHAR_RPAR:
-    token = makeToken(SB_RPAR, lineNo, colNo);
-    readChar(); 
-    return token;
-  default:
-    token = makeToken(TK_NONE, lineNo, colNo);
-    error(ERR_INVALID_SYMBOL, lineNo, colNo);
-    readChar(); 
+
+    token = makeToken(rule->single, offset);
+    if (rule->single == TK_NONE)
+      error(ERR_INVALID_SYMBOL, offset);
     return token;
   }
 }
@@ -247,8 +209,10 @@ Token* getValidToken(void) {
 /******************************************************************/
 
 void printToken(Token *token) {
+  int lineNo, colNo;
 
-  printf("%d-%d:", token->lineNo, token->colNo);
+  getLineCol(token->offset, &lineNo, &colNo);
+  printf("%d-%d:", lineNo, colNo);
 
   switch (token->tokenType) {
   case TK_NONE: printf("TK_NONE\n"); break;
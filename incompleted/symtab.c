@@ -6,37 +6,191 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "symtab.h"
 #include "error.h"
 
 void freeObject(Object* obj);
 void freeScope(Scope* scope);
 void freeObjectList(ObjectNode *objList);
+void freeParamList(ObjectNode *paramList);
 void freeReferenceList(ObjectNode *objList);
 
 SymTab* symtab;
-Type* intType;
-Type* charType;
+
+// Kiểu cơ sở dùng chung, là dữ liệu tĩnh và không bao giờ được giải phóng
+Type intTypeData = {TP_INT, INT_SIZE, 0, NULL};
+Type charTypeData = {TP_CHAR, CHAR_SIZE, 0, NULL};
+Type* intType = &intTypeData;
+Type* charType = &charTypeData;
+
+/* Các hàm/thủ tục có sẵn là dữ liệu chỉ đọc, được khởi tạo hoàn toàn lúc
+ * biên dịch. Mỗi built-in là một dòng của BUILTINS: tên, loại, kiểu trả về
+ * và tối đa MAX_BUILTIN_PARAMS tham số (NO_PARAM nếu không có). Từ dòng đó
+ * sinh ra đối tượng, scope, node trong danh sách toàn cục và các tham số. */
+#define BUILTINS(X) \
+    X(READC,   FUNCTION,  &charTypeData, NO_PARAM,                  NO_PARAM) \
+    X(READI,   FUNCTION,  &intTypeData,  NO_PARAM,                  NO_PARAM) \
+    X(WRITEI,  PROCEDURE, NULL,          VALUE_PARAM("i", TP_INT),   NO_PARAM) \
+    X(WRITEC,  PROCEDURE, NULL,          VALUE_PARAM("ch", TP_CHAR), NO_PARAM) \
+    X(WRITELN, PROCEDURE, NULL,          NO_PARAM,                  NO_PARAM)
+
+#define MAX_BUILTIN_PARAMS 2
+
+// Tham số: (có mặt, tên, loại truyền, lớp kiểu cơ sở)
+#define NO_PARAM                (0, "", PARAM_VALUE, TP_INT)
+#define VALUE_PARAM(n, tc)      (1, n, PARAM_VALUE, tc)
+#define VAR_PARAM(n, tc)        (1, n, PARAM_REFERENCE, tc)
+
+#define PARAM_PRESENT(p)        PARAM_PRESENT_ p
+#define PARAM_PRESENT_(pr, n, k, tc) pr
+#define PARAM_NAME(p)           PARAM_NAME_ p
+#define PARAM_NAME_(pr, n, k, tc) n
+#define PARAM_KIND(p)           PARAM_KIND_ p
+#define PARAM_KIND_(pr, n, k, tc) k
+#define PARAM_TC(p)             PARAM_TC_ p
+#define PARAM_TC_(pr, n, k, tc) tc
+#define PARAM_TYPE(p)           (PARAM_TC(p) == TP_CHAR ? &charTypeData : &intTypeData)
+
+/* Bố trí frame giống hệt declareObject/allocateFrameSlot: tham số trị chiếm
+ * kích thước kiểu của nó, tham số biến chiếm một địa chỉ; kiểu cơ sở và địa
+ * chỉ đều được căn lề theo chính kích thước của chúng. */
+#define PARAM_SIZE(p) \
+    (PARAM_KIND(p) == PARAM_REFERENCE ? ADDRESS_SIZE : \
+     PARAM_TC(p) == TP_CHAR ? CHAR_SIZE : INT_SIZE)
+#define ALIGN_UP(x, a)          (((x) + (a) - 1) / (a) * (a))
+#define FRAME_BASE              (RESERVED_WORDS * WORD_SIZE)
+#define PARAM0_OFFSET(p0)       ALIGN_UP(FRAME_BASE, PARAM_SIZE(p0))
+#define PARAM1_OFFSET(p0, p1)   ALIGN_UP(PARAM0_OFFSET(p0) + PARAM_SIZE(p0), PARAM_SIZE(p1))
+#define BUILTIN_FRAME_SIZE(p0, p1) \
+    (PARAM_PRESENT(p1) ? PARAM1_OFFSET(p0, p1) + PARAM_SIZE(p1) : \
+     PARAM_PRESENT(p0) ? PARAM0_OFFSET(p0) + PARAM_SIZE(p0) : FRAME_BASE)
+
+// Built-in có cùng mức lồng nhau với thủ tục khai báo ở đầu chương trình
+#define BUILTIN_LEVEL 1
+
+#define BUILTIN_ID(id, k, returnTp, p0, p1) BI_##id,
+
+enum BuiltinId {
+    BUILTINS(BUILTIN_ID)
+    BUILTINS_COUNT
+};
+
+#define BUILTIN_CHECK(id, k, returnTp, p0, p1) \
+    _Static_assert(PARAM_PRESENT(p0) || !PARAM_PRESENT(p1), #id ": second parameter given without a first");
+
+BUILTINS(BUILTIN_CHECK)
+
+struct Builtin {
+    Object object;
+    Scope scope;
+    ObjectNode node;
+    Object params[MAX_BUILTIN_PARAMS];
+    ObjectNode paramNodes[MAX_BUILTIN_PARAMS];
+};
+
+extern const struct Builtin builtins[BUILTINS_COUNT];
+
+// Bảng nằm trong vùng chỉ đọc; các con trỏ trong Object không có const nên ép
+// kiểu một lần ở đây. Không chỗ nào ghi vào built-in.
+#define BI_REF(type, id, field) ((type*) &builtins[id].field)
+
+#define BUILTIN_PARAM_LIST(id, p0) \
+    (PARAM_PRESENT(p0) ? BI_REF(ObjectNode, id, paramNodes[0]) : NULL)
+
+#define BUILTIN_ATTRS_FUNCTION(id, returnTp, p0) \
+    .funcAttrs = { \
+        .paramList = BUILTIN_PARAM_LIST(id, p0), \
+        .returnType = returnTp, \
+        .scope = BI_REF(Scope, id, scope) \
+    }
+
+#define BUILTIN_ATTRS_PROCEDURE(id, returnTp, p0) \
+    .procAttrs = { \
+        .paramList = BUILTIN_PARAM_LIST(id, p0), \
+        .scope = BI_REF(Scope, id, scope) \
+    }
+
+#define BUILTIN_PARAM(id, p, offset) \
+    { \
+        .kind = OBJ_PARAMETER, \
+        .name = PARAM_NAME(p), \
+        .paramAttrs = { \
+            .kind = PARAM_KIND(p), \
+            .type = PARAM_TYPE(p), \
+            .function = BI_REF(Object, id, object), \
+            .level = BUILTIN_LEVEL, \
+            .localOffset = offset \
+        } \
+    }
+
+#define BUILTIN_ENTRY(id, k, returnTp, p0, p1) \
+    [BI_##id] = { \
+        .object = { \
+            .kind = OBJ_##k, \
+            .name = #id, \
+            BUILTIN_ATTRS_##k(BI_##id, returnTp, p0) \
+        }, \
+        .scope = { \
+            .objList = NULL, \
+            .owner = BI_REF(Object, BI_##id, object), \
+            .outer = NULL, \
+            .level = BUILTIN_LEVEL, \
+            .frameSize = BUILTIN_FRAME_SIZE(p0, p1) \
+        }, \
+        .node = { \
+            .object = BI_REF(Object, BI_##id, object), \
+            .next = BI_##id + 1 < BUILTINS_COUNT ? BI_REF(ObjectNode, BI_##id + 1, node) : NULL \
+        }, \
+        .params = { \
+            BUILTIN_PARAM(BI_##id, p0, PARAM0_OFFSET(p0)), \
+            BUILTIN_PARAM(BI_##id, p1, PARAM1_OFFSET(p0, p1)) \
+        }, \
+        .paramNodes = { \
+            { \
+                .object = BI_REF(Object, BI_##id, params[0]), \
+                .next = PARAM_PRESENT(p1) ? BI_REF(ObjectNode, BI_##id, paramNodes[1]) : NULL \
+            }, \
+            { \
+                .object = BI_REF(Object, BI_##id, params[1]), \
+                .next = NULL \
+            } \
+        } \
+    },
+
+const struct Builtin builtins[BUILTINS_COUNT] = {
+    BUILTINS(BUILTIN_ENTRY)
+};
 
 /******************* Type utilities ******************************/
 
 Type* makeIntType(void) {
     Type* type = (Type*) malloc(sizeof(Type));
     type->typeClass = TP_INT;
+    type->size = INT_SIZE;
     return type;
 }
 
 Type* makeCharType(void) {
     Type* type = (Type*) malloc(sizeof(Type));
     type->typeClass = TP_CHAR;
+    type->size = CHAR_SIZE;
     return type;
 }
 
+// Trả về NULL nếu tổng số byte của mảng vượt quá INT_MAX
 Type* makeArrayType(int arraySize, Type* elementType) {
-    Type* type = (Type*) malloc(sizeof(Type));
+    int elementSize = sizeOfType(elementType);
+    Type* type;
+
+    if (arraySize > 0 && elementSize > INT_MAX / arraySize)
+        return NULL;
+
+    type = (Type*) malloc(sizeof(Type));
     type->typeClass = TP_ARRAY;
     type->arraySize = arraySize;
     type->elementType = elementType;
+    type->size = arraySize * elementSize;
     return type;
 }
 
@@ -45,6 +199,7 @@ Type* duplicateType(Type* type) {
     
     Type* resultType = (Type*) malloc(sizeof(Type));
     resultType->typeClass = type->typeClass;
+    resultType->size = type->size;
     if (type->typeClass == TP_ARRAY) {
         resultType->arraySize = type->arraySize;
         resultType->elementType = duplicateType(type->elementType);
@@ -65,7 +220,8 @@ int compareType(Type* type1, Type* type2) {
 }
 
 void freeType(Type* type) {
-    if (type == NULL) return;
+    // intType và charType là dữ liệu tĩnh dùng chung
+    if (type == NULL || type == intType || type == charType) return;
     
     switch (type->typeClass) {
     case TP_INT:
@@ -80,6 +236,34 @@ void freeType(Type* type) {
     }
 }
 
+int sizeOfType(Type* type) {
+    if (type == NULL) return 0;
+    return type->size;
+}
+
+int alignOfType(Type* type) {
+    if (type == NULL) return 1;
+
+    // Mảng được căn lề theo kiểu phần tử cơ sở của nó
+    while (type->typeClass == TP_ARRAY && type->elementType != NULL)
+        type = type->elementType;
+    return (type->typeClass == TP_CHAR) ? CHAR_SIZE : INT_SIZE;
+}
+
+// Cấp một ô trong frame của scope, căn lề theo align; trả về vị trí của ô,
+// hoặc -1 (giữ nguyên frameSize) nếu frame vượt quá INT_MAX byte
+int allocateFrameSlot(Scope* scope, int size, int align) {
+    int offset;
+
+    if (scope->frameSize > INT_MAX - (align - 1))
+        return -1;
+    offset = (scope->frameSize + align - 1) / align * align;
+    if (size > INT_MAX - offset)
+        return -1;
+    scope->frameSize = offset + size;
+    return offset;
+}
+
 /******************* Constant utility ******************************/
 
 ConstantValue* makeIntConstant(int i) {
@@ -115,6 +299,9 @@ Scope* createScope(Object* owner, Scope* outer) {
     scope->objList = NULL;
     scope->owner = owner;
     scope->outer = outer;
+    // Mức lồng nhau và kích thước frame (bắt đầu sau các từ dành riêng)
+    scope->level = (outer == NULL) ? 0 : outer->level + 1;
+    scope->frameSize = RESERVED_WORDS * WORD_SIZE;
     return scope;
 }
 
@@ -122,8 +309,7 @@ Object* createProgramObject(char *programName) {
     Object* program = (Object*) malloc(sizeof(Object));
     strcpy(program->name, programName);
     program->kind = OBJ_PROGRAM;
-    program->progAttrs = (ProgramAttributes*) malloc(sizeof(ProgramAttributes));
-    program->progAttrs->scope = createScope(program,NULL);
+    program->progAttrs.scope = createScope(program,NULL);
     symtab->program = program;
 
     return program;
@@ -133,8 +319,7 @@ Object* createConstantObject(char *name) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_CONSTANT;
-    obj->constAttrs = (ConstantAttributes*) malloc(sizeof(ConstantAttributes));
-    obj->constAttrs->value = NULL; // Thêm khởi tạo
+    obj->constAttrs.value = NULL; // Thêm khởi tạo
     return obj;
 }
 
@@ -142,8 +327,7 @@ Object* createTypeObject(char *name) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_TYPE;
-    obj->typeAttrs = (TypeAttributes*) malloc(sizeof(TypeAttributes));
-    obj->typeAttrs->actualType = NULL; // Thêm khởi tạo
+    obj->typeAttrs.actualType = NULL; // Thêm khởi tạo
     return obj;
 }
 
@@ -151,9 +335,10 @@ Object* createVariableObject(char *name) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_VARIABLE;
-    obj->varAttrs = (VariableAttributes*) malloc(sizeof(VariableAttributes));
-    obj->varAttrs->type = NULL; // Thêm khởi tạo
-    obj->varAttrs->scope = symtab->currentScope;
+    obj->varAttrs.type = NULL; // Thêm khởi tạo
+    obj->varAttrs.scope = symtab->currentScope;
+    obj->varAttrs.level = 0;
+    obj->varAttrs.localOffset = 0;
     return obj;
 }
 
@@ -161,10 +346,9 @@ Object* createFunctionObject(char *name) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_FUNCTION;
-    obj->funcAttrs = (FunctionAttributes*) malloc(sizeof(FunctionAttributes));
-    obj->funcAttrs->returnType = NULL; // Thêm khởi tạo
-    obj->funcAttrs->paramList = NULL;
-    obj->funcAttrs->scope = createScope(obj, symtab->currentScope);
+    obj->funcAttrs.returnType = NULL; // Thêm khởi tạo
+    obj->funcAttrs.paramList = NULL;
+    obj->funcAttrs.scope = createScope(obj, symtab->currentScope);
     return obj;
 }
 
@@ -172,9 +356,8 @@ Object* createProcedureObject(char *name) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_PROCEDURE;
-    obj->procAttrs = (ProcedureAttributes*) malloc(sizeof(ProcedureAttributes));
-    obj->procAttrs->paramList = NULL;
-    obj->procAttrs->scope = createScope(obj, symtab->currentScope);
+    obj->procAttrs.paramList = NULL;
+    obj->procAttrs.scope = createScope(obj, symtab->currentScope);
     return obj;
 }
 
@@ -182,10 +365,11 @@ Object* createParameterObject(char *name, enum ParamKind kind, Object* owner) {
     Object* obj = (Object*) malloc(sizeof(Object));
     strcpy(obj->name, name);
     obj->kind = OBJ_PARAMETER;
-    obj->paramAttrs = (ParameterAttributes*) malloc(sizeof(ParameterAttributes));
-    obj->paramAttrs->kind = kind;
-    obj->paramAttrs->type = NULL; // Thêm khởi tạo
-    obj->paramAttrs->function = owner;
+    obj->paramAttrs.kind = kind;
+    obj->paramAttrs.type = NULL; // Thêm khởi tạo
+    obj->paramAttrs.function = owner;
+    obj->paramAttrs.level = 0;
+    obj->paramAttrs.localOffset = 0;
     return obj;
 }
 
@@ -194,37 +378,31 @@ void freeObject(Object* obj) {
 
     switch (obj->kind) {
     case OBJ_CONSTANT:
-      if (obj->constAttrs->value != NULL) free(obj->constAttrs->value);
-      free(obj->constAttrs);
+      if (obj->constAttrs.value != NULL) free(obj->constAttrs.value);
       break;
     case OBJ_TYPE:
-      if (obj->typeAttrs->actualType != NULL) freeType(obj->typeAttrs->actualType);
-      free(obj->typeAttrs);
+      if (obj->typeAttrs.actualType != NULL) freeType(obj->typeAttrs.actualType);
       break;
     case OBJ_VARIABLE:
-      // Sửa: KHÔNG free type vì nó có thể là intType/charType hoặc kiểu chia sẻ
-      free(obj->varAttrs);
+      // Mỗi biến sở hữu kiểu riêng; freeType bỏ qua intType/charType dùng chung
+      if (obj->varAttrs.type != NULL) freeType(obj->varAttrs.type);
       break;
     case OBJ_FUNCTION:
-      // Sửa: Phải dùng freeObjectList để giải phóng các OBJ_PARAMETER và node của chúng
-      if (obj->funcAttrs->paramList != NULL) freeObjectList(obj->funcAttrs->paramList);
-      if (obj->funcAttrs->returnType != NULL) freeType(obj->funcAttrs->returnType);
-      freeScope(obj->funcAttrs->scope);
-      free(obj->funcAttrs);
+      // paramList sở hữu các OBJ_PARAMETER; objList của scope chỉ tham chiếu tới
+      // chúng nên phải giải phóng scope trước
+      freeScope(obj->funcAttrs.scope);
+      if (obj->funcAttrs.paramList != NULL) freeParamList(obj->funcAttrs.paramList);
+      if (obj->funcAttrs.returnType != NULL) freeType(obj->funcAttrs.returnType);
       break;
     case OBJ_PROCEDURE:
-      // Sửa: Phải dùng freeObjectList để giải phóng các OBJ_PARAMETER và node của chúng
-      if (obj->procAttrs->paramList != NULL) freeObjectList(obj->procAttrs->paramList);
-      freeScope(obj->procAttrs->scope);
-      free(obj->procAttrs);
+      freeScope(obj->procAttrs.scope);
+      if (obj->procAttrs.paramList != NULL) freeParamList(obj->procAttrs.paramList);
       break;
     case OBJ_PROGRAM:
-      freeScope(obj->progAttrs->scope);
-      free(obj->progAttrs);
+      freeScope(obj->progAttrs.scope);
       break;
     case OBJ_PARAMETER:
       // Sửa: KHÔNG free type
-      free(obj->paramAttrs);
       break;
     }
     free(obj);
@@ -255,6 +433,17 @@ void freeObjectList(ObjectNode *objList) {
     }
 }
 
+void freeParamList(ObjectNode *paramList) {
+    ObjectNode* list = paramList;
+
+    while (list != NULL) {
+      ObjectNode* node = list;
+      list = list->next;
+      free(node->object);
+      free(node);
+    }
+}
+
 void freeReferenceList(ObjectNode *objList) {
     ObjectNode* list = objList;
 
@@ -292,54 +481,20 @@ Object* findObject(ObjectNode *objList, char *name) {
 /******************* others ******************************/
 
 void initSymTab(void) {
-    Object* obj;
-    Object* param;
-
     symtab = (SymTab*) malloc(sizeof(SymTab));
-    symtab->globalObjectList = NULL;
-    
-    // Khởi tạo các hàm/thủ tục built-in
-    
-    obj = createFunctionObject("READC");
-    obj->funcAttrs->returnType = makeCharType();
-    addObject(&(symtab->globalObjectList), obj);
-
-    obj = createFunctionObject("READI");
-    obj->funcAttrs->returnType = makeIntType();
-    addObject(&(symtab->globalObjectList), obj);
-
-    obj = createProcedureObject("WRITEI");
-    param = createParameterObject("i", PARAM_VALUE, obj);
-    param->paramAttrs->type = makeIntType();
-    addObject(&(obj->procAttrs->paramList),param);
-    addObject(&(symtab->globalObjectList), obj);
-
-    obj = createProcedureObject("WRITEC");
-    param = createParameterObject("ch", PARAM_VALUE, obj);
-    param->paramAttrs->type = makeCharType();
-    addObject(&(obj->procAttrs->paramList),param);
-    addObject(&(symtab->globalObjectList), obj);
-
-    obj = createProcedureObject("WRITELN");
-    addObject(&(symtab->globalObjectList), obj);
+    symtab->program = NULL;
+    symtab->currentScope = NULL;
 
-    // Khởi tạo kiểu dữ liệu cơ sở toàn cục
-    intType = makeIntType();
-    charType = makeCharType();
+    // Các built-in là dữ liệu tĩnh chỉ đọc, không cấp phát cho mỗi lần dịch
+    symtab->globalObjectList = BI_REF(ObjectNode, BI_READC, node);
 }
 
 void cleanSymTab(void) {
     // Giải phóng Program Object
     if (symtab->program != NULL) freeObject(symtab->program);
-    
-    // Giải phóng Built-in Objects
-    if (symtab->globalObjectList != NULL) freeObjectList(symtab->globalObjectList);
-    
+
+    // Built-in và kiểu cơ sở là dữ liệu tĩnh, không giải phóng
     free(symtab);
-    
-    // Giải phóng kiểu dữ liệu cơ sở toàn cục
-    freeType(intType);
-    freeType(charType);
 }
 
 void enterBlock(Scope* scope) {
@@ -350,6 +505,13 @@ void exitBlock(void) {
     symtab->currentScope = symtab->currentScope->outer;
 }
 
+// Giải phóng các đối tượng cục bộ của scope nhưng giữ lại scope cùng chữ ký
+// (paramList, kiểu trả về) mà scope bao ngoài còn cần
+void releaseScope(Scope* scope) {
+    freeObjectList(scope->objList);
+    scope->objList = NULL;
+}
+
 Object* lookupObject(char *name) {
     // TODO: Hoàn thành hàm lookupObject
     Scope* scope = symtab->currentScope;
@@ -367,19 +529,41 @@ Object* lookupObject(char *name) {
 }
 
 void declareObject(Object* obj) {
+    Scope* scope = symtab->currentScope;
+
+    // Ghi lại mức lồng nhau và vị trí trong frame để truy cập biến không cục bộ
+    // trong thời gian hằng (display) thay vì lần theo static link
+    switch (obj->kind) {
+    case OBJ_VARIABLE:
+        obj->varAttrs.level = scope->level;
+        obj->varAttrs.localOffset = allocateFrameSlot(scope, sizeOfType(obj->varAttrs.type),
+                                                      alignOfType(obj->varAttrs.type));
+        break;
+    case OBJ_PARAMETER:
+        obj->paramAttrs.level = scope->level;
+        if (obj->paramAttrs.kind == PARAM_VALUE)
+            obj->paramAttrs.localOffset = allocateFrameSlot(scope, sizeOfType(obj->paramAttrs.type),
+                                                            alignOfType(obj->paramAttrs.type));
+        else
+            obj->paramAttrs.localOffset = allocateFrameSlot(scope, ADDRESS_SIZE, ADDRESS_SIZE);
+        break;
+    default:
+        break;
+    }
+
     if (obj->kind == OBJ_PARAMETER) {
-        Object* owner = symtab->currentScope->owner;
+        Object* owner = scope->owner;
         switch (owner->kind) {
         case OBJ_FUNCTION:
-            addObject(&(owner->funcAttrs->paramList), obj);
+            addObject(&(owner->funcAttrs.paramList), obj);
             break;
         case OBJ_PROCEDURE:
-            addObject(&(owner->procAttrs->paramList), obj);
+            addObject(&(owner->procAttrs.paramList), obj);
             break;
         default:
             break;
         }
     }
     
-    addObject(&(symtab->currentScope->objList), obj);
+    addObject(&(scope->objList), obj);
 }
\ No newline at end of file
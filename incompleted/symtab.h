@@ -9,6 +9,13 @@
 
 #include "token.h"
 
+// Kích thước tính theo byte; CHAR dùng biểu diễn hẹp nhất là một byte
+#define INT_SIZE 4
+#define CHAR_SIZE 1
+#define ADDRESS_SIZE 4
+#define WORD_SIZE 4
+#define RESERVED_WORDS 4
+
 enum TypeClass {
   TP_INT,
   TP_CHAR,
@@ -30,8 +37,13 @@ enum ParamKind {
   PARAM_REFERENCE
 };
 
+/* Mảng nhiều chiều ARRAY(.m.) OF ARRAY(.n.) OF T được lưu liền một khối.
+ * size (tổng số byte) được tính một lần khi tạo kiểu, nên bước nhảy của mỗi
+ * chiều chính là elementType->size và A(.I.)(.J.) chỉ cần một phép nhân-cộng
+ * cho mỗi chiều. */
 struct Type_ {
   enum TypeClass typeClass;
+  int size;
   int arraySize;
   struct Type_ *elementType;
 };
@@ -61,6 +73,8 @@ struct ConstantAttributes_ {
 struct VariableAttributes_ {
   Type *type;
   struct Scope_ *scope;
+  int level;
+  int localOffset;
 };
 
 struct TypeAttributes_ {
@@ -86,6 +100,8 @@ struct ParameterAttributes_ {
   enum ParamKind kind;
   Type* type;
   struct Object_ *function;
+  int level;
+  int localOffset;
 };
 
 typedef struct ConstantAttributes_ ConstantAttributes;
@@ -96,17 +112,19 @@ typedef struct ProcedureAttributes_ ProcedureAttributes;
 typedef struct ProgramAttributes_ ProgramAttributes;
 typedef struct ParameterAttributes_ ParameterAttributes;
 
+/* Thuộc tính được lưu ngay trong Object (union có nhãn kind) thay vì cấp phát
+ * riêng, để mỗi lần truy cập ký hiệu chỉ cần một lần đọc bộ nhớ. */
 struct Object_ {
-  char name[MAX_IDENT_LEN];
   enum ObjectKind kind;
+  char name[MAX_IDENT_LEN + 1];
   union {
-    ConstantAttributes* constAttrs;
-    VariableAttributes* varAttrs;
-    TypeAttributes* typeAttrs;
-    FunctionAttributes* funcAttrs;
-    ProcedureAttributes* procAttrs;
-    ProgramAttributes* progAttrs;
-    ParameterAttributes* paramAttrs;
+    ConstantAttributes constAttrs;
+    VariableAttributes varAttrs;
+    TypeAttributes typeAttrs;
+    FunctionAttributes funcAttrs;
+    ProcedureAttributes procAttrs;
+    ProgramAttributes progAttrs;
+    ParameterAttributes paramAttrs;
   };
 };
 
@@ -123,6 +141,8 @@ struct Scope_ {
   ObjectNode *objList;
   Object *owner;
   struct Scope_ *outer;
+  int level;
+  int frameSize;
 };
 
 typedef struct Scope_ Scope;
@@ -141,6 +161,8 @@ Type* makeArrayType(int arraySize, Type* elementType);
 Type* duplicateType(Type* type);
 int compareType(Type* type1, Type* type2);
 void freeType(Type* type);
+int sizeOfType(Type* type);
+int alignOfType(Type* type);
 
 ConstantValue* makeIntConstant(int i);
 ConstantValue* makeCharConstant(char ch);
@@ -162,6 +184,7 @@ void initSymTab(void);
 void cleanSymTab(void);
 void enterBlock(Scope* scope);
 void exitBlock(void);
+void releaseScope(Scope* scope);
 Object* lookupObject(char *name);
 void declareObject(Object* obj);
 
@@ -8,30 +8,34 @@
 #include <ctype.h>
 #include "token.h"
 
-struct {
+/* Bảng băm địa chỉ mở cho từ khóa, là dữ liệu hằng nên có thể tra cứu từ
+ * nhiều luồng cùng lúc. Mỗi từ khóa nằm ở ô hashString(từ khóa) mod
+ * KEYWORD_HASH_SIZE (hoặc ô trống kế tiếp nếu trùng); ô có string rỗng là ô
+ * trống. Khi thêm từ khóa phải tính lại vị trí của nó theo cùng quy tắc. */
+const struct {
   char string[MAX_IDENT_LEN + 1];
   TokenType tokenType;
-} keywords[KEYWORDS_COUNT] = {
-  {"PROGRAM", KW_PROGRAM},
-  {"CONST", KW_CONST},
-  {"TYPE", KW_TYPE},
-  {"VAR", KW_VAR},
-  {"INTEGER", KW_INTEGER},
-  {"CHAR", KW_CHAR},
-  {"ARRAY", KW_ARRAY},
-  {"OF", KW_OF},
-  {"FUNCTION", KW_FUNCTION},
-  {"PROCEDURE", KW_PROCEDURE},
-  {"BEGIN", KW_BEGIN},
-  {"END", KW_END},
-  {"CALL", KW_CALL},
-  {"IF", KW_IF},
-  {"THEN", KW_THEN},
-  {"ELSE", KW_ELSE},
-  {"WHILE", KW_WHILE},
-  {"DO", KW_DO},
-  {"FOR", KW_FOR},
-  {"TO", KW_TO}
+} keywordSlots[KEYWORD_HASH_SIZE] = {
+  [6] = {"ARRAY", KW_ARRAY},
+  [7] = {"IF", KW_IF},
+  [9] = {"FUNCTION", KW_FUNCTION},
+  [10] = {"END", KW_END},
+  [13] = {"TYPE", KW_TYPE},
+  [20] = {"DO", KW_DO},
+  [29] = {"CHAR", KW_CHAR},
+  [30] = {"VAR", KW_VAR},
+  [31] = {"BEGIN", KW_BEGIN},
+  [36] = {"TO", KW_TO},
+  [37] = {"INTEGER", KW_INTEGER},
+  [40] = {"OF", KW_OF},
+  [41] = {"CALL", KW_CALL},
+  [43] = {"PROGRAM", KW_PROGRAM},
+  [46] = {"PROCEDURE", KW_PROCEDURE},
+  [47] = {"WHILE", KW_WHILE},
+  [48] = {"ELSE", KW_ELSE},
+  [49] = {"FOR", KW_FOR},
+  [52] = {"CONST", KW_CONST},
+  [54] = {"THEN", KW_THEN}
 };
 
 int keywordEq(char *kw, char *string) {
@@ -42,19 +46,30 @@ int keywordEq(char *kw, char *string) {
   return ((*kw == '\0') && (*string == '\0'));
 }
 
+unsigned int hashString(char *string) {
+  unsigned int h = 2166136261u;
+  while (*string != '\0') {
+    h = (h ^ (unsigned char) *string) * 16777619u;
+    string ++;
+  }
+  return h;
+}
+
 TokenType checkKeyword(char *string) {
-  int i;
-  for (i = 0; i < KEYWORDS_COUNT; i++)
-    if (keywordEq(keywords[i].string, string)) 
-      return keywords[i].tokenType;
+  unsigned int slot = hashString(string) & (KEYWORD_HASH_SIZE - 1);
+
+  while (keywordSlots[slot].string[0] != '\0') {
+    if (keywordEq((char*) keywordSlots[slot].string, string))
+      return keywordSlots[slot].tokenType;
+    slot = (slot + 1) & (KEYWORD_HASH_SIZE - 1);
+  }
   return TK_NONE;
 }
 
-Token* makeToken(TokenType tokenType, int lineNo, int colNo) {
+Token* makeToken(TokenType tokenType, int offset) {
   Token *token = (Token*)malloc(sizeof(Token));
   token->tokenType = tokenType;
-  token->lineNo = lineNo;
-  token->colNo = colNo;
+  token->offset = offset;
   return token;
 }
 
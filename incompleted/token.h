@@ -9,6 +9,7 @@
 
 #define MAX_IDENT_LEN 15
 #define KEYWORDS_COUNT 20
+#define KEYWORD_HASH_SIZE 64
 
 typedef enum {
   TK_NONE, TK_IDENT, TK_NUMBER, TK_CHAR, TK_EOF,
@@ -28,13 +29,13 @@ typedef enum {
 
 typedef struct {
   char string[MAX_IDENT_LEN + 1];
-  int lineNo, colNo;
+  int offset;		// vị trí byte trong mã nguồn, đổi ra dòng-cột khi cần
   TokenType tokenType;
   int value;
 } Token;
 
 TokenType checkKeyword(char *string);
-Token* makeToken(TokenType tokenType, int lineNo, int colNo);
+Token* makeToken(TokenType tokenType, int offset);
 char *tokenToString(TokenType tokenType);
 
 
@@ -21,5 +21,21 @@ do
   echo "=============================="
 done
 
+echo ""
+echo "===== RUN ALL TESTS (STREAMING, -s) ====="
+
+for f in tests/example*.kpl
+do
+  echo ""
+  echo "=============================="
+  echo "TEST FILE: $f (-s)"
+  echo "------------------------------"
+
+  # in từng khai báo ngay khi phân tích xong và giải phóng scope cục bộ
+  incompleted/kplc -s "$f"
+
+  echo "=============================="
+done
+
 echo ""
 echo "===== DONE ====="